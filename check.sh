@@ -0,0 +1,207 @@
+#!/bin/sh
+#
+# Differential tests: run each d8bup engine and the reference
+# implementation (d8bup-ref) on randomly generated streams (from d8gen),
+# and compare output bytes and log messages.
+#
+# Usage: check.sh <logfile> <number of streams> <engine> ..
+#
+# An engine is a d8bup binary, normally built with different CHUNKSIZEs.
+# Streams which fail are kept as check-fail-<seed>.raw; regenerate with
+# ./d8gen <seed>.
+
+# Single output option sets, compared byte for byte, log included.
+# -s uses a stream dependent position, see run_options.
+OPTIONS="-t
+-c 2
+-c 4
+-c 6
+-x 2
+-x 4
+-x 6
+-f
+-c 4 -f
+-m
+-n
+-t -C 2
+-c 4 -C 2
+-n -C 2
+-n -C 3
+-S -E
+-z -S -E
+-z -t
+-z -S -E -C 2
+-s"
+
+log_and_print() {
+  tee -a $LOGFILE
+}
+
+log() {
+  cat >> $LOGFILE
+}
+
+# Compare engine output and log with those of the reference
+compare() {
+  what=$1
+  cmp -s check-ref.out check-engine.out && cmp -s check-ref.log check-engine.log
+  if [ $? -ne 0 ]; then
+    echo "Stream $seed: $what differs from reference" | log_and_print
+    cp check.raw check-fail-$seed.raw
+    FAILED=y
+  fi
+}
+
+# Run $1 with $options, writing output to $2.out and log to $2.log
+run_one() {
+  case "$options" in
+    *-f*) # Output file is named from song name, so run in an empty
+          # directory, and output file names followed by file contents.
+          rm -rf check-dir
+          mkdir check-dir
+          (cd check-dir && ../$1 $options < ../check.raw > /dev/null 2> ../$2.log)
+          (cd check-dir && ls && cat *.raw 2> /dev/null) > $2.out
+          ;;
+    *)    $1 $options < check.raw > $2.out 2> $2.log
+          ;;
+  esac
+}
+
+run_options() {
+  options=$1
+  [ "$options" = "-s" ] && options="-s $((seed * 7 % 20000))"
+  run_one ./d8bup-ref check-ref
+  for engine in $ENGINES; do
+    run_one $engine check-engine
+    compare "$engine $options"
+  done
+}
+
+# Tee mode: each output must be the same as in a single output run.
+# Logs differ (labels), so only outputs are compared.
+run_tee() {
+  ./d8bup-ref -t < check.raw > check-ref-t.out 2> /dev/null
+  ./d8bup-ref -c 4 < check.raw > check-ref-c4.out 2> /dev/null
+  ./d8bup-ref -n < check.raw > check-ref-n.out 2> /dev/null
+  for engine in $ENGINES; do
+    rm -f check-tee-*.out
+    $engine -t -o check-tee-t.out -T -c 4 -o check-tee-c4.out -T -n \
+      < check.raw > check-tee-n.out 2> /dev/null
+    for output in t c4 n; do
+      cmp -s check-ref-$output.out check-tee-$output.out
+      if [ $? -ne 0 ]; then
+        echo "Stream $seed: $engine tee output $output differs from reference" | log_and_print
+        cp check.raw check-fail-$seed.raw
+        FAILED=y
+      fi
+    done
+  done
+}
+
+# Tee mode with two outputs, where one may stop before the other.
+run_tee_pair() {
+  ./d8bup-ref $1 < check.raw > check-ref-1.out 2> /dev/null
+  ./d8bup-ref $2 < check.raw > check-ref-2.out 2> /dev/null
+  for engine in $ENGINES; do
+    rm -f check-tee-*.out
+    $engine $1 -o check-tee-1.out -T $2 -o check-tee-2.out \
+      < check.raw 2> /dev/null
+    for output in 1 2; do
+      cmp -s check-ref-$output.out check-tee-$output.out
+      if [ $? -ne 0 ]; then
+        echo "Stream $seed: $engine tee $1 -T $2 output $output differs from reference" | log_and_print
+        cp check.raw check-fail-$seed.raw
+        FAILED=y
+      fi
+    done
+  done
+}
+
+# Tee mode with several -f outputs; each is named from the song name, so
+# compare file names and contents with sequential reference runs in the
+# same order.
+run_tee_f() {
+  rm -rf check-dir
+  mkdir check-dir
+  (cd check-dir &&
+   for options in "-f" "-c 4 -f" "-x 2 -f"; do
+     ../d8bup-ref $options < ../check.raw > /dev/null 2>&1
+   done
+   ls && cat *.raw 2> /dev/null) > check-ref-f.out
+  for engine in $ENGINES; do
+    rm -rf check-dir
+    mkdir check-dir
+    (cd check-dir &&
+     ../$engine -f -T -c 4 -f -T -x 2 -f < ../check.raw > /dev/null 2>&1
+     ls && cat *.raw 2> /dev/null) > check-tee-f.out
+    cmp -s check-ref-f.out check-tee-f.out
+    if [ $? -ne 0 ]; then
+      echo "Stream $seed: $engine tee -f outputs differ from reference" | log_and_print
+      cp check.raw check-fail-$seed.raw
+      FAILED=y
+    fi
+  done
+}
+
+# Split mode has no reference, but a split output must get every input
+# sample even when another output skips songs with -C, so compare it
+# with a single output split run of the same engine.
+run_tee_split() {
+  for engine in $ENGINES; do
+    rm -rf check-dir
+    mkdir check-dir
+    (cd check-dir &&
+     ../$engine -P 2000 -o a < ../check.raw > /dev/null 2>&1
+     ../$engine -C 2 -t -o full.raw -T -P 2000 -o b < ../check.raw \
+       > /dev/null 2>&1
+     [ $(ls a-*.raw 2> /dev/null | wc -l) = $(ls b-*.raw 2> /dev/null | wc -l) ] &&
+     for file in a-*.raw; do
+       [ -f $file ] || continue
+       cmp -s $file b-${file#a-} || exit 1
+     done)
+    if [ $? -ne 0 ]; then
+      echo "Stream $seed: $engine split output with -C 2 tee differs" | log_and_print
+      cp check.raw check-fail-$seed.raw
+      FAILED=y
+    fi
+  done
+}
+
+LOGFILE=$1
+STREAMS=$2
+shift 2
+ENGINES=$*
+rm -f $LOGFILE check-fail-*.raw check-failed
+
+echo "Running d8bup differential tests on $STREAMS streams" | log_and_print
+echo "Engines: $ENGINES" | log
+
+seed=1
+while [ $seed -le $STREAMS ]; do
+  ./d8gen $seed > check.raw
+  echo "$OPTIONS" | while read options; do
+    run_options "$options"
+    # FAILED is set in a subshell here, so pass it on through a file
+    [ "$FAILED" ] && touch check-failed
+  done
+  run_tee
+  run_tee_pair "-x 2" "-S -E"
+  run_tee_pair "-x 4" "-t"
+  run_tee_pair "-c 2" "-t"
+  run_tee_pair "-S -E" "-x 6"
+  run_tee_pair "-c 6" "-n"
+  run_tee_f
+  run_tee_split
+  [ "$FAILED" ] && touch check-failed
+  seed=$((seed + 1))
+done
+
+rm -rf check.raw check-*.out check-*.log check-dir
+if [ -f check-failed ]; then
+  rm -f check-failed
+  echo "Differential tests FAILED!" | log_and_print
+  echo "Log in $LOGFILE"
+  exit 1
+fi
+echo "Differential tests OK!" | log_and_print
+echo "Log in $LOGFILE"
@@ -14,9 +14,16 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
 
-#define CHUNKSIZE 4096
 #define SAMPLESIZE 4 /* 2 bytes per sample * 2 channels */
+#ifndef CHUNKSIZE /* may be overridden for testing, see make check */
+#define CHUNKSIZE 4096
+#endif
+#if CHUNKSIZE % SAMPLESIZE
+#error CHUNKSIZE must be a multiple of SAMPLESIZE
+#endif
 #define SAMPLERATE 44100
 #define ONE_SECOND SAMPLERATE
 #define TWO_HOURS (SAMPLERATE * 60 * 60 *2) /* a long long time */
@@ -57,6 +64,9 @@ struct stream
   int bytecount;
   int bufptr;
   int eof;
+  int pace; /* set for -p: write output in real time */
+  long long paced_samples; /* #samples written when pacing */
+  struct timespec pace_start; /* time when first chunk was written */
 };
 
 struct sa_stream
@@ -73,7 +83,7 @@ struct sa_stream
 struct stream *stream_init(int fd, int chunksize)
 {
   struct stream *stream = malloc(sizeof(struct stream));
-  memset(stream, sizeof(struct stream), 0);
+  memset(stream, 0, sizeof(struct stream));
   stream->fd = fd;
   stream->buf = malloc(chunksize);
   return stream;
@@ -109,11 +119,38 @@ int read_chunk(struct stream *stream)
   return res;
 }
 
+/* When pacing output (-p), wait until the samples written so far
+ * have been played at SAMPLERATE, so that we are never more than
+ * one chunk ahead of playback. */
+void pace_chunk(struct stream *stream)
+{
+  struct timespec due;
+  long long ns;
+
+  if (stream->paced_samples == 0)
+    clock_gettime(CLOCK_MONOTONIC, &stream->pace_start);
+
+  ns = stream->paced_samples * 1000000000LL / SAMPLERATE;
+  due.tv_sec = stream->pace_start.tv_sec + ns / 1000000000;
+  due.tv_nsec = stream->pace_start.tv_nsec + ns % 1000000000;
+  if (due.tv_nsec >= 1000000000) {
+    due.tv_sec++;
+    due.tv_nsec -= 1000000000;
+  }
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR)
+    ;
+
+  stream->paced_samples += stream->bufptr / SAMPLESIZE;
+}
+
 int write_chunk(struct stream *stream)
 {
   int res;
   int writeptr = 0;
 
+  if (stream->pace)
+    pace_chunk(stream);
+
   while (writeptr < stream->bufptr) {
     res = write(stream->fd, &stream->buf[writeptr], stream->bufptr - writeptr);
     if (res < 0) {
@@ -148,16 +185,28 @@ int read_bytes(struct stream *stream, char *buf, int bytes)
 }
 
 /* write bytes to output stream */
-/* CHUNK_SIZE must be a multiple of bytes */
+/* bytes may span several chunks */
 int write_bytes(struct stream *stream, const char *buf, int bytes)
 {
-  memcpy(&stream->buf[stream->bufptr], buf, bytes);
-  stream->bufptr += bytes;
-
-  if (stream->bufptr < CHUNKSIZE)
-    return 0;
+  int res = 0;
+
+  while (bytes > 0) {
+    int len = CHUNKSIZE - stream->bufptr; /* room left in chunk */
+    if (len > bytes)
+      len = bytes;
+    memcpy(&stream->buf[stream->bufptr], buf, len);
+    stream->bufptr += len;
+    buf += len;
+    bytes -= len;
+
+    if (stream->bufptr >= CHUNKSIZE) {
+      res = write_chunk(stream);
+      if (res < 0)
+        return res;
+    }
+  }
 
-  return write_chunk(stream);
+  return res;
 }
 
 /* flush output stream */
@@ -189,7 +238,7 @@ char *sampletime(int samples)
 struct sa_stream* sa_stream_init(void *buf, struct stream *stream)
 {
   struct sa_stream *sa_stream = malloc(sizeof(struct sa_stream));
-  memset(sa_stream, sizeof(struct sa_stream), 0);
+  memset(sa_stream, 0, sizeof(struct sa_stream));
   sa_stream->buf = buf;
   sa_stream->stream = stream;
   return sa_stream;
@@ -226,7 +275,7 @@ int copy_sample(struct sa_stream *sa_stream)
   res = write_bytes(sa_stream->stream, sa_stream->buf, SAMPLESIZE);
   if (res < 0)
     return res;
-  sa_stream->bytecount += res;
+  sa_stream->bytecount += SAMPLESIZE;
   sa_stream->samplecount++;
 
   return 0;
@@ -269,7 +318,7 @@ struct match
 struct match *match_init(const void *match_data, int match_len)
 {
   struct match *match = malloc(sizeof(struct match));
-  memset(match, sizeof(struct match), 0);
+  memset(match, 0, sizeof(struct match));
   match->string = match_data;
   match->matchlen = match_len;
   return match;
@@ -356,7 +405,7 @@ struct extractor *extract_init(struct extractor *extractor,
 {
   if (extractor == NULL) { /* first time called */
     extractor = malloc(sizeof(struct extractor));
-    memset(extractor, sizeof(struct extractor), 0);
+    memset(extractor, 0, sizeof(struct extractor));
   } else {
     extractor->bytecount = 0; /* restart output */
   }
@@ -376,8 +425,11 @@ char *make_filename(const char *songname, int cut)
                      /*          cut var ext nul */
                      /* e.g.    -4tr -1  .raw    */
 
+  if (!songname) /* no song found in input */
+    songname = "untitled";
   /* assert(strlen(songname) <= NAMELEN); */
   strncpy(filename, songname, NAMELEN);
+  filename[NAMELEN] = '\0'; /* strncpy doesn't terminate a full length name */
   if (cut)
     sprintf(filename + strlen(filename), "-%dtr", cut * 2);
 
@@ -422,6 +474,232 @@ char *trim_space(char *s)
   return s;
 }
 
+/* sink functions */
+
+/* Each output specification on the command line is a sink, with its own
+ * start/stop rules and output stream. All sinks are fed from the same
+ * pass over the input stream, so several files can be written from a
+ * single (live) capture. */
+
+#define MAX_SINKS 8 /* max number of outputs (-T) */
+
+struct sink
+{
+  char label[8]; /* prefix for messages, empty when only one sink */
+  int searchpos; /* set to search position when -s encountered */
+  int start_on_sync; /* set in all modes where we start on sync tone */
+  int stop_on_song_end; /* set for -t only */
+  int expand; /* !=0 when -x encountered */
+  int cut; /* !=0 when -c encountered */
+  int name_only; /* set for -n; output name then stop */
+  int songname_as_filename; /* set for -f */
+  int pace; /* set for -p */
+  int start_on_sound; /* start output when input samples are != 0 */
+  int stop_on_silence; /* terminate output when 1s of 0 samples received */
+  const char *filename; /* use specified file name instead of stdout */
+  const char *tempfilename; /* used for -f until song name is known */
+  int split_gap; /* !=0 for -P: min #samples of silence between regions */
+  int split_pre; /* #samples of silence before each region (-B) */
+  int split_post; /* #samples of silence after each region (-A) */
+  int split_min; /* discard regions shorter than this (-L) */
+  int split_options; /* set when -B, -A or -L given */
+  struct sa_stream *output;
+  struct match *quiet; /* silence matcher for -E */
+  int copying; /* copying data from input to output stream */
+  int start_copying; /* trigger to start copying; reset once started */
+  int stop_copying; /* trigger to stop copying; reset once done */
+  int finished; /* set when sink has stopped for good */
+  int song_delta; /* song length when sink stopped */
+  int read_bytes; /* #bytes read from input when sink stopped */
+  int read_samples; /* #samples read from input when sink stopped */
+  char *split_prefix; /* -o filename without .raw, numbered for each region */
+  char *split_filename; /* file name of current region */
+  int split_active; /* currently writing a region */
+  int split_quiet; /* #quiet samples since last nonzero sample */
+  int split_length; /* #samples in current region, excluding pre/post roll */
+  int split_regions; /* #regions written */
+  int split_fileno; /* number of last region file, skipping existing files */
+};
+
+struct sink *sink_init(int sinkno)
+{
+  struct sink *sink = malloc(sizeof(struct sink));
+  memset(sink, 0, sizeof(struct sink));
+  sink->searchpos = -1;
+  if (sinkno == 1)
+    sink->tempfilename = tempfilename;
+  else {
+    char *name = malloc(strlen(tempfilename) + 4 + 1);
+    sprintf(name, "d8bup.tmp-%d.raw", sinkno);
+    sink->tempfilename = name;
+  }
+  return sink;
+}
+
+/* Check the options of a sink. Done for all sinks before any output
+ * file is created, so that an error doesn't leave files behind. */
+int sink_check(struct sink *sink)
+{
+  if (sink->expand && sink->cut) {
+    fprintf(stderr, "%smay only specify one of -x -and -c\n", sink->label);
+    return 1;
+  }
+
+  if (sink->filename && sink->songname_as_filename) {
+    fprintf(stderr, "%smay only specify one of -f and -o\n", sink->label);
+    return 1;
+  }
+
+  if (sink->split_options && !sink->split_gap) {
+    fprintf(stderr, "%s-B, -A and -L may only be used with -P\n", sink->label);
+    return 1;
+  }
+
+  if (sink->split_gap) {
+    if (sink->start_on_sync || sink->name_only || sink->songname_as_filename ||
+        sink->start_on_sound || sink->stop_on_silence || sink->searchpos >= 0) {
+      fprintf(stderr, "%s-P may not be combined with -s -m -t -x -c -n -f "
+                      "-S or -E\n", sink->label);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* Open the output file of a sink. */
+int sink_open(struct sink *sink, void *sa_stream_buf, const char *quiet_data)
+{
+  int output_fd = 1; /* default to stdout */
+
+  if (sink->split_gap) {
+    const char *prefix = sink->filename ? sink->filename : "region";
+    int len = strlen(prefix);
+    if (len > 4 && strcmp(prefix + len - 4, ".raw") == 0)
+      len -= 4; /* we add our own extension */
+    sink->split_prefix = malloc(len + 1);
+    strncpy(sink->split_prefix, prefix, len);
+    sink->split_prefix[len] = '\0';
+    sink->split_filename = malloc(len + 16 + 4 + 1);
+                                   /* var ext nul */
+    output_fd = -1; /* opened for each region */
+  }
+  else if (sink->songname_as_filename)
+  {
+    sink->filename = sink->tempfilename;
+    unlink(sink->tempfilename);
+  }
+
+  if (sink->filename && !sink->split_gap) {
+    output_fd = open(sink->filename, O_CREAT | O_EXCL | O_WRONLY, 
+                     S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (output_fd < 0) {
+      perror("Creating output file");
+      return 1;
+    }
+  }
+
+  struct stream *output_low = stream_init(output_fd, CHUNKSIZE);
+  output_low->pace = sink->pace;
+  /* Use same buf for output as input to avoid copying */
+  sink->output = sa_stream_init(sa_stream_buf, output_low);
+  sink->quiet = match_init(quiet_data, ONE_SECOND * SAMPLESIZE);
+
+  return 0;
+}
+
+/* split functions */
+
+/* In split mode (-P), each sound region separated from the next by at
+ * least split_gap samples of silence is written to its own numbered file.
+ * Runs of silence are counted rather than buffered, so memory use is
+ * constant regardless of the length of the input. */
+
+int split_open(struct sa_stream *input, struct sink *sink)
+{
+  int fd;
+
+  /* loop until a unique name found, skipping files from earlier runs */
+  while (1) {
+    sprintf(sink->split_filename, "%s-%02d.raw", sink->split_prefix,
+            sink->split_fileno + 1);
+    fd = open(sink->split_filename, O_CREAT | O_EXCL | O_WRONLY, 
+              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd >= 0)
+      break;
+    if (errno != EEXIST) {
+      perror("\nCreating region output file");
+      return fd;
+    }
+    fprintf(stderr, "\n%s%s exists, skipping", sink->label,
+            sink->split_filename);
+    sink->split_fileno++;
+  }
+  sink->output->stream->fd = fd;
+  sink->split_active = 1;
+  sink->split_length = 0;
+  fprintf(stderr, "\n%sFound nonzero sample at %s, copying to %s",
+          sink->label, sampletime(input->samplecount), sink->split_filename);
+  silence(sink->output, sink->split_pre);
+  return 0;
+}
+
+int split_close(struct sa_stream *input, struct sink *sink)
+{
+  silence(sink->output, sink->split_post);
+  int res = flush(sink->output->stream);
+  close(sink->output->stream->fd);
+  sink->output->stream->fd = -1;
+  sink->split_active = 0;
+  if (res < 0) {
+    perror("\nWriting region output file");
+    return res;
+  }
+
+  if (sink->split_length < sink->split_min) {
+    fprintf(stderr, "\n%sRegion of %s at %s too short, discarding %s",
+            sink->label, sampletime(sink->split_length),
+            sampletime(input->samplecount), sink->split_filename);
+    unlink(sink->split_filename);
+    /* don't count discarded samples as written */
+    int samples = sink->split_pre + sink->split_length + sink->split_post;
+    sink->output->samplecount -= samples;
+    sink->output->bytecount -= samples * SAMPLESIZE;
+    return 0;
+  }
+
+  sink->split_regions++;
+  sink->split_fileno++;
+  fprintf(stderr, "\n%sEnd of region at %s, region length is %s",
+          sink->label, sampletime(input->samplecount),
+          sampletime(sink->split_length));
+  return 0;
+}
+
+/* Handle one input sample; returns < 0 on error */
+int split_sample(struct sa_stream *input, struct sink *sink)
+{
+  if (is_quiet(input)) {
+    sink->split_quiet++;
+    if (sink->split_active && sink->split_quiet >= sink->split_gap)
+      return split_close(input, sink);
+    return 0;
+  }
+
+  if (!sink->split_active) {
+    if (split_open(input, sink) < 0)
+      return -1;
+  } else { /* silence within region is kept */
+    silence(sink->output, sink->split_quiet);
+    sink->split_length += sink->split_quiet;
+  }
+  sink->split_quiet = 0;
+
+  copy_sample(sink->output);
+  sink->split_length++;
+  return 0;
+}
+
 /* Check range of arguments for -x and -c options. */
 int xc_rangecheck(int *arg, const char *what)
 {
@@ -436,7 +714,7 @@ int xc_rangecheck(int *arg, const char *what)
 
 void usage(void)
 {
-  fprintf(stderr, "Usage: d8bup [options]\n"
+  fprintf(stderr, "Usage: d8bup [options] [-T [options] ..]\n"
                   "Filter D8 backup files from stdin to stdout\n"
                   "Options:\n"
                   "-s <sampleno>  Start output on sampleno\n"
@@ -445,97 +723,146 @@ void usage(void)
                   "-x <2, 4 or 6> Expand output from given number of tracks\n"
                   "-c <2, 4 or 6> Cut output after given number of tracks\n"
                   "-z             Don't break input: read input until eof\n"
-                  "-n             Output name to stdout, then exit\n"
+                  "-n             Output name, then stop this output\n"
                   "-o <filename>  Use specified filename instead of stdout\n"
+                  "-f             Use song name as output filename\n"
+                  "-p             Pace output in real time, for playback "
+                  "(not with -T)\n"
                   "-C <n>         Skip songs until song n found (n = 1,2,..)\n"
                   "-S             Start when any input sample != 0\n"
                   "-E             End when 1s of silence detected\n"
+                  "-P <samples>   Split into numbered files on given length "
+                  "of silence\n"
+                  "-B <samples>   With -P, silence to output before each "
+                  "region\n"
+                  "-A <samples>   With -P, silence to output after each "
+                  "region\n"
+                  "-L <samples>   With -P, discard regions shorter than "
+                  "given length\n"
+                  "-T             Start options for another output (tee)\n"
                   "-h             This list\n"
                   "For -x, -c and -t, output an additional one second of "
-                  "silence at end of file\n");
+                  "silence at end of file\n"
+                  "-z and -C apply to all outputs; other options apply to the "
+                  "output being specified.\n"
+                  "At most one output may use stdout.\n"
+                  "With -P, -o gives the base name of the numbered files "
+                  "(default region-NN.raw).\n"
+                  "Existing numbered files are skipped.\n");
 }
 
 int main(int argc, char **argv)
 {
   int argcount = 0; /* command line argument count */
-  int searchpos = -1; /* set to search position when -s encountered */
-  int start_on_sync = 0; /* set in all modes where we start on sync tone */
-  int stop_on_song_end = 0; /* set for -t only */
-  int expand = 0; /* !=0 when -x encountered */
-  int cut = 0; /* !=0 when -c encountered */
   int break_input = 1; /* cleared for -z mode */
-  int name_only = 0; /* set for -n; output name then exit */
-  int songname_as_filename = 0; /* set for -f */
   int synctone_count = 1; /* which song are we looking for ? */
-  int start_on_sound = 0; /* start output when input samples are != 0 */
-  int stop_on_silence = 0; /* terminate output when 1s of 0 samples received */
-  const char *filename = NULL; /* use specified file name instead of stdout */
-  int output_fd = 1; /* default to stdout */
+  struct sink *sinks[MAX_SINKS]; /* outputs, separated by -T */
+  int nsinks = 1;
+  int sinkno;
+  struct sink *sink = sinks[0] = sink_init(1); /* sink being specified */
   
   while (argcount < argc) {
     if (argv[argcount][0] == '-') {
       switch (argv[argcount][1]) {
-        case 's': searchpos = atoi(argv[++argcount]); break;
-        case 'm': start_on_sync = 1; break;
-        case 'x': expand = atoi(argv[++argcount]);
-                  if (xc_rangecheck(&expand, "expand (-x)"))
+        case 's': sink->searchpos = atoi(argv[++argcount]); break;
+        case 'm': sink->start_on_sync = 1; break;
+        case 'x': sink->expand = atoi(argv[++argcount]);
+                  if (xc_rangecheck(&sink->expand, "expand (-x)"))
                     return 1;
-                  start_on_sync = 1; break;
-        case 't': start_on_sync = 1; stop_on_song_end = 1; break;
-        case 'c': cut = atoi(argv[++argcount]);
-                  if (xc_rangecheck(&cut, "cut (-c)"))
+                  sink->start_on_sync = 1; break;
+        case 't': sink->start_on_sync = 1; sink->stop_on_song_end = 1; break;
+        case 'c': sink->cut = atoi(argv[++argcount]);
+                  if (xc_rangecheck(&sink->cut, "cut (-c)"))
                     return 1;
-                  start_on_sync = 1; break;
+                  sink->start_on_sync = 1; break;
         case 'z': break_input = 0; break;
-        case 'n': name_only = 1; break;
-        case 'o': filename = argv[++argcount]; break;
-        case 'f': songname_as_filename = 1; break;
+        case 'n': sink->name_only = 1; break;
+        case 'o': sink->filename = argv[++argcount]; break;
+        case 'f': sink->songname_as_filename = 1; break;
+        case 'p': sink->pace = 1; break;
         case 'C': synctone_count = atoi(argv[++argcount]);
                   if (synctone_count < 1) {
                     fprintf(stderr, "argument to -C must be >= 1!");
                     return 1;
                   }
                   break;
-        case 'S': start_on_sound = 1; break;
-        case 'E': stop_on_silence = 1; break;
+        case 'S': sink->start_on_sound = 1; break;
+        case 'E': sink->stop_on_silence = 1; break;
+        case 'P': sink->split_gap = atoi(argv[++argcount]);
+                  if (sink->split_gap < 1) {
+                    fprintf(stderr, "argument to -P must be >= 1!");
+                    return 1;
+                  }
+                  break;
+        case 'B': sink->split_pre = atoi(argv[++argcount]);
+                  if (sink->split_pre < 0) {
+                    fprintf(stderr, "argument to -B must be >= 0!");
+                    return 1;
+                  }
+                  sink->split_options = 1; break;
+        case 'A': sink->split_post = atoi(argv[++argcount]);
+                  if (sink->split_post < 0) {
+                    fprintf(stderr, "argument to -A must be >= 0!");
+                    return 1;
+                  }
+                  sink->split_options = 1; break;
+        case 'L': sink->split_min = atoi(argv[++argcount]);
+                  if (sink->split_min < 0) {
+                    fprintf(stderr, "argument to -L must be >= 0!");
+                    return 1;
+                  }
+                  sink->split_options = 1; break;
+        case 'T': if (nsinks == MAX_SINKS) {
+                    fprintf(stderr, "at most %d outputs may be specified\n",
+                            MAX_SINKS);
+                    return 1;
+                  }
+                  sink = sinks[nsinks] = sink_init(nsinks + 1);
+                  nsinks++;
+                  break;
         case 'h': /* fall through */
 	default: usage(); return 0;
       }
     }
     ++argcount;
   }
-  if (expand && cut) {
-    fprintf(stderr, "may only specify one of -x -and -c\n");
-    exit(1);
-  }
 
-  if (filename && songname_as_filename) {
-    fprintf(stderr, "may only specify one of -f and -o\n");
-    exit(1);
+  int stdout_sinks = 0; /* only one sink may write to stdout */
+  int name_sinks = 0; /* number of -n sinks */
+  for (sinkno = 0; sinkno < nsinks; sinkno++) {
+    sink = sinks[sinkno];
+    if (nsinks > 1)
+      sprintf(sink->label, "[%d] ", sinkno + 1);
+    if (!sink->filename && !sink->songname_as_filename && !sink->split_gap)
+      stdout_sinks++;
+    if (sink->name_only)
+      name_sinks++;
+  }
+  /* Everything runs in one loop, so pacing one output would throttle the
+   * input and all other outputs, and -x expansion would be delayed until
+   * the other outputs are done. */
+  if (nsinks > 1) {
+    for (sinkno = 0; sinkno < nsinks; sinkno++) {
+      if (sinks[sinkno]->pace) {
+        fprintf(stderr, "-p may only be used with a single output\n");
+        exit(1);
+      }
+    }
   }
 
-  if (songname_as_filename)
-  {
-    filename = tempfilename;
-    unlink(tempfilename);
+  if (stdout_sinks > 1) {
+    fprintf(stderr, "only one output may use stdout, use -o or -f\n");
+    exit(1);
   }
 
-  if (filename) {
-    output_fd = open(filename, O_CREAT | O_EXCL | O_WRONLY, 
-                     S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-    if (output_fd < 0) {
-      perror("Creating output file");
+  for (sinkno = 0; sinkno < nsinks; sinkno++)
+    if (sink_check(sinks[sinkno]))
       exit(1);
-    }
-  }
 
   struct stream *input_low = stream_init(0 /* stdin */, CHUNKSIZE);
-  struct stream *output_low = stream_init(output_fd, CHUNKSIZE);
 
   void *sa_stream_buf = malloc(SAMPLESIZE);
   struct sa_stream *input = sa_stream_init(sa_stream_buf, input_low);
-  /* Use same buf for output as input to avoid copying */
-  struct sa_stream *output = sa_stream_init(sa_stream_buf, output_low);
 
   struct match *syncblip = match_init(syncblip_data, strlen(syncblip_data));
 
@@ -543,7 +870,16 @@ int main(int argc, char **argv)
 
   char *quiet_data = malloc(ONE_SECOND * SAMPLESIZE);
   memset(quiet_data, 0, ONE_SECOND * SAMPLESIZE); /* create silence */
-  struct match *quiet = match_init(quiet_data, ONE_SECOND * SAMPLESIZE);
+
+  for (sinkno = 0; sinkno < nsinks; sinkno++) {
+    if (sink_open(sinks[sinkno], sa_stream_buf, quiet_data)) {
+      /* remove files already created by earlier sinks */
+      while (sinkno--)
+        if (sinks[sinkno]->filename && !sinks[sinkno]->split_gap)
+          unlink(sinks[sinkno]->filename);
+      exit(1);
+    }
+  }
 
   /* We use a struct for this so that we can reinitialize the extractor
    * for each name we find (when scanning multiple backups).
@@ -555,9 +891,7 @@ int main(int argc, char **argv)
   struct extractor *extract_name = extract_init(NULL, &name_init);
 
   int done = 0; /* looping condition */
-  int copying = 0; /* copying data from input to output stream */
-  int start_copying = 0; /* trigger to start copying; reset once started */
-  int stop_copying = 0; /* trigger to stop copying; reset once done */
+  int errors = 0; /* set when an output had to be stopped due to an error */
   int syncblips = 0; /* # sync blips found in in put stream */
   int synctone_found = 0; /* set to 1 once sync tone found, and never reset */
   int blipsample = 0; /* sample no of latest sync blip */
@@ -580,24 +914,52 @@ int main(int argc, char **argv)
       done = 1;
     }
     
-    if (input->samplecount == searchpos)
-      start_copying = 1;
+    for (sinkno = 0; sinkno < nsinks; sinkno++) {
+      sink = sinks[sinkno];
+      if (sink->finished)
+        continue;
+
+      /* Split sinks get every sample, so feed them before the sync
+       * scan below, which may skip the rest of the loop for -C. */
+      if (sink->split_gap) {
+        if (!input->eof && split_sample(input, sink) < 0) {
+          /* stop this output, but let the others finish cleanly */
+          fprintf(stderr, "\n%sStopping output at %s.", sink->label,
+                  sampletime(input->samplecount));
+          sink->finished = 1;
+          sink->read_bytes = input->bytecount;
+          sink->read_samples = input->samplecount;
+          errors = 1;
+        }
+        continue;
+      }
+
+      if (input->samplecount == sink->searchpos)
+        sink->start_copying = 1;
 
-    if (!copying && start_on_sound && !is_quiet(input)) {
-      fprintf(stderr, "\nFound nonzero sample at %s, copying to output",
-              sampletime(input->samplecount));
-      start_copying = 1;
+      if (!sink->copying && sink->start_on_sound && !is_quiet(input)) {
+        fprintf(stderr, "\n%sFound nonzero sample at %s, copying to output",
+                sink->label, sampletime(input->samplecount));
+        sink->start_copying = 1;
+      }
     }
 
     if (!synctone_found && match(input, synctone)) {
+      int started = 0; /* any sink started on this sync tone */
+
       fprintf(stderr, "\nFound synctone at %s", sampletime(input->samplecount));
       synctone_found = 1;
-      if (synctone_count == 1 && start_on_sync) {
-        silence(output, ONE_SECOND);
-        /* restore part of sync tone that would be skipped due to matching */
-        output_samples(output, synctone_data, SYNCTONESIZE-1);
-        start_copying = 1;
-      } else
+      for (sinkno = 0; sinkno < nsinks; sinkno++) {
+        sink = sinks[sinkno];
+        if (synctone_count == 1 && sink->start_on_sync && !sink->finished) {
+          silence(sink->output, ONE_SECOND);
+          /* restore part of sync tone that would be skipped due to matching */
+          output_samples(sink->output, synctone_data, SYNCTONESIZE-1);
+          sink->start_copying = 1;
+          started = 1;
+        }
+      }
+      if (!started)
         fprintf(stderr, " (skipping)");
     }
 
@@ -606,9 +968,13 @@ int main(int argc, char **argv)
       fprintf(stderr, "\nSong name: \"%s\"", songname);
       if (synctone_found) { /* a valid song has been found (not skipping) */
         found_name = 1;
-        if (name_only) {
-          printf("%s\n", songname);
-          done = 1;
+        for (sinkno = 0; sinkno < nsinks; sinkno++) {
+          sink = sinks[sinkno];
+          if (sink->name_only && !sink->finished) {
+            write_bytes(sink->output->stream, songname, strlen(songname));
+            write_bytes(sink->output->stream, "\n", 1);
+            sink->finished = 1;
+          }
         }
       } else {
         fprintf(stderr, " (skipping)");
@@ -650,99 +1016,163 @@ int main(int argc, char **argv)
           song_delta = delta; /* grab maximum of all deltas */
       }
 
-      /* The following can only happen after >= 4 sync blips, so we know
-       * song_delta has been set. */
-      if (expand && syncblips - 3 == expand) {
-        fprintf(stderr, "\nWill expand with silence and blips from %s",
-                sampletime(input->samplecount));
-        stop_copying = 1;
-      }
+      for (sinkno = 0; sinkno < nsinks; sinkno++) {
+        sink = sinks[sinkno];
+        if (sink->finished)
+          continue;
+
+        /* The following can only happen after >= 4 sync blips, so we know
+         * song_delta has been set. */
+        if (sink->expand && syncblips - 3 == sink->expand) {
+          fprintf(stderr, "\n%sWill expand with silence and blips from %s",
+                  sink->label, sampletime(input->samplecount));
+          sink->stop_copying = 1;
+        }
 
-      /* The following can only happen after >= 4 sync blips, so we know
-       * song_delta has been set. */
-      if (cut && syncblips - 3 == cut) {
-        fprintf(stderr, "\nCutting input from %s, stopping output.", 
-                sampletime(input->samplecount));
-        stop_copying = 1;
+        /* The following can only happen after >= 4 sync blips, so we know
+         * song_delta has been set. */
+        if (sink->cut && syncblips - 3 == sink->cut) {
+          fprintf(stderr, "\n%sCutting input from %s, stopping output.", 
+                  sink->label, sampletime(input->samplecount));
+          sink->stop_copying = 1;
+        }
       }
       
       blipsample = input->samplecount;
     }
 
-    if (stop_on_song_end && copying && syncblips >= 6 && 
-        input->samplecount == blipsample + song_delta) {
-      fprintf(stderr, "\nReached end of song at %s, stopping output.",
-              sampletime(input->samplecount));
-      stop_copying = 1;
-    }
+    int running = 0; /* number of sinks not finished yet */
 
-    if (stop_on_silence && copying && match(input, quiet)) {
-      fprintf(stderr, "\nFound 1s of silence at %s, stopping output.",
-              sampletime(input->samplecount));
-      stop_copying = 1;
-    }
+    for (sinkno = 0; sinkno < nsinks; sinkno++) {
+      sink = sinks[sinkno];
+      if (sink->finished)
+        continue;
 
-    if (start_copying && !copying) {
-      fprintf(stderr, "\nCopying to output from %s", sampletime(input->samplecount));
-      copying = 1;
-      start_copying = 0;
-    }
+      if (sink->split_gap) { /* fed above */
+        running++;
+        continue;
+      }
 
-    if (copying)
-      copy_sample(output);
+      if (sink->stop_on_song_end && sink->copying && syncblips >= 6 && 
+          input->samplecount == blipsample + song_delta) {
+        fprintf(stderr, "\n%sReached end of song at %s, stopping output.",
+                sink->label, sampletime(input->samplecount));
+        sink->stop_copying = 1;
+      }
 
-    if (stop_copying) {
-      copying = stop_copying = 0;
-      if (break_input)
-      {
-        fprintf(stderr, "\nStopped copying; breaking input at %s.",
-                        sampletime(input->samplecount));
-        done = 1; /* don't consume any more input bytes */
+      if (sink->stop_on_silence && sink->copying &&
+          match(input, sink->quiet)) {
+        fprintf(stderr, "\n%sFound 1s of silence at %s, stopping output.",
+                sink->label, sampletime(input->samplecount));
+        sink->stop_copying = 1;
       }
-    }
-  }
 
-  if (name_only)
-    goto exit_ok;
+      if (sink->start_copying && !sink->copying) {
+        fprintf(stderr, "\n%sCopying to output from %s", sink->label,
+                sampletime(input->samplecount));
+        sink->copying = 1;
+        sink->start_copying = 0;
+      }
 
-  if (expand) {
-    expand = 4 - expand; /* output 3, 2 or 1 segment(s) of silence */
-    while (expand--) {
-      fprintf(stderr, "\nOutputting %s of silence", sampletime(song_delta));
-      silence(output, song_delta);
-      if (expand) { /* don't output blip after last expansion */
-        fprintf(stderr, "\nOutputting sync blip");
-        output_samples(output, syncblip_data, SYNCBLIPSIZE);
+      if (sink->copying)
+        copy_sample(sink->output);
+
+      if (sink->stop_copying) {
+        sink->copying = sink->stop_copying = 0;
+        if (break_input)
+        {
+          if (nsinks == 1)
+            fprintf(stderr, "\nStopped copying; breaking input at %s.",
+                            sampletime(input->samplecount));
+          else /* other sinks may still need input */
+            fprintf(stderr, "\n%sStopped copying at %s.",
+                            sink->label, sampletime(input->samplecount));
+          sink->finished = 1; /* don't consume any more input bytes */
+          /* other sinks may keep reading, so remember where we stopped */
+          sink->song_delta = song_delta;
+          sink->read_bytes = input->bytecount;
+          sink->read_samples = input->samplecount;
+        }
       }
+
+      if (!sink->finished)
+        running++;
+    }
+
+    if (!running) {
+      if (nsinks > 1)
+        fprintf(stderr, "\nAll outputs stopped; breaking input at %s.",
+                        sampletime(input->samplecount));
+      done = 1; /* all sinks done */
     }
-    /* expand will now be -1, which is ok, as we only use it as a boolean
-     * below. */
   }
 
-  if (expand || cut || stop_on_song_end)
-    silence(output, ONE_SECOND);
+  for (sinkno = 0; sinkno < nsinks; sinkno++) {
+    sink = sinks[sinkno];
+    struct sa_stream *output = sink->output;
+
+    if (!sink->finished) { /* ran until end of input */
+      sink->song_delta = song_delta;
+      sink->read_bytes = input->bytecount;
+      sink->read_samples = input->samplecount;
+    }
+
+    if (sink->name_only) {
+      flush(output->stream); /* write song name */
+      continue;
+    }
 
-  flush(output->stream); /* write final bytes */
+    if (sink->split_gap) {
+      if (sink->split_active && split_close(input, sink) < 0)
+        errors = 1;
+      fprintf(stderr, "\n%sWrote %d region%s", sink->label,
+              sink->split_regions, PLURAL(sink->split_regions));
+      fprintf(stderr, "\n%sRead %d samples, wrote %d samples", sink->label,
+              sink->read_samples, output->samplecount);
+      continue;
+    }
 
-  if (songname_as_filename) {
-    filename = make_filename(songname, cut);
-    if (!filename) {
-      perror("\nFinding output filename");
-      exit(2);
+    if (sink->expand) {
+      int expand = 4 - sink->expand; /* output 3, 2 or 1 segment(s) of silence */
+      while (expand--) {
+        fprintf(stderr, "\n%sOutputting %s of silence", sink->label,
+                sampletime(sink->song_delta));
+        silence(output, sink->song_delta);
+        if (expand) { /* don't output blip after last expansion */
+          fprintf(stderr, "\n%sOutputting sync blip", sink->label);
+          output_samples(output, syncblip_data, SYNCBLIPSIZE);
+        }
+      }
     }
-    fprintf(stderr, "\nWill use output file name %s", filename);
-    if (rename(tempfilename, filename) < 0) {
-      perror("\nRenaming output file");
-      exit(2);
+
+    if (sink->expand || sink->cut || sink->stop_on_song_end)
+      silence(output, ONE_SECOND);
+
+    flush(output->stream); /* write final bytes */
+
+    if (sink->songname_as_filename) {
+      const char *filename = make_filename(songname, sink->cut);
+      if (!filename) {
+        perror("\nFinding output filename");
+        exit(2);
+      }
+      fprintf(stderr, "\n%sWill use output file name %s", sink->label,
+              filename);
+      if (rename(sink->tempfilename, filename) < 0) {
+        perror("\nRenaming output file");
+        exit(2);
+      }
     }
+
+    fprintf(stderr, "\n%sRead %d bytes, wrote %d bytes", sink->label,
+            sink->read_bytes, output->bytecount);
+    fprintf(stderr, "\n%sRead %d samples, wrote %d samples", sink->label,
+            sink->read_samples, output->samplecount);
   }
 
-  fprintf(stderr, "\nRead %d bytes, wrote %d bytes", input->bytecount, output->bytecount);
-  fprintf(stderr, "\nRead %d samples, wrote %d samples", input->samplecount, output->samplecount);
-  if (song_delta)
+  if (song_delta && name_sinks < nsinks)
     fprintf(stderr, "\nSong length is %s", sampletime(song_delta));
 
-exit_ok:
   fprintf(stderr, "\n");
-  return 0;
+  return errors ? 2 : 0;
 }
@@ -0,0 +1,171 @@
+/*
+ * d8gen.c
+ * Generate random D8 backup like streams for make check.
+ *
+ * Usage: d8gen <seed> > stream.raw
+ *
+ * The stream consists of 0 to 3 songs, each with noise, a sync tone, a
+ * sync blip followed by a song name, and up to six track pairs, with
+ * random lengths of silence in between. Lengths are random so that
+ * patterns end up straddling chunk boundaries, and some silences are
+ * long enough to trigger -E. Near misses of the sync tone and sync blip
+ * patterns are inserted to exercise the matcher, and the stream may end
+ * with a partial sample. The same seed always gives the same stream.
+ *
+ * Released under the GNU GPL.
+ * Copyright (C) 2013 Ricard Wanderlof.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SAMPLESIZE 4 /* 2 bytes per sample * 2 channels */
+#define SAMPLERATE 44100
+#define ONE_SECOND SAMPLERATE
+
+#define NAMELEN 16 /* length of D8 name string */
+#define NAME_OFFSET 11 /* #samples from 1. syncblip */
+
+#define SYNCBLIPSIZE 4 /* #samples */
+static const char syncblip_data[] = "\x76\x53\x19\x52"
+                                    "\x76\x53\x19\x52"
+                                    "\x76\x53\x19\x52"
+                                    "\x76\x53\x19\x52";
+
+#define SYNCTONESIZE 4 /* #samples */
+static const char synctone_data[] = "\x00\x00\x00\x00"
+                                    "\x00\x10\x00\x10"
+                                    "\x00\x10\x00\x10"
+                                    "\x00\x10\x00\x10";
+
+static const char name_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -";
+
+/* Own generator, so that streams don't depend on the C library */
+static unsigned long rand_state;
+
+int rnd(int n) /* 0 .. n-1 */
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 16) % n;
+}
+
+int range(int min, int max) /* min .. max */
+{
+  return min + rnd(max - min + 1);
+}
+
+void output_samples(const char *buf, int samples)
+{
+  fwrite(buf, SAMPLESIZE, samples, stdout);
+}
+
+void silence(int samples)
+{
+  static const char quiet_sample[SAMPLESIZE];
+
+  while (samples--)
+    output_samples(quiet_sample, 1);
+}
+
+/* Random audio, with occasional zero samples */
+void noise(int samples)
+{
+  char sample[SAMPLESIZE];
+  int byteno;
+
+  while (samples--) {
+    for (byteno = 0; byteno < SAMPLESIZE; byteno++)
+      sample[byteno] = rnd(4) ? rnd(256) : 0;
+    output_samples(sample, 1);
+  }
+}
+
+/* Either a short, a medium or a (more than) one second silence */
+void random_silence(void)
+{
+  switch (rnd(4)) {
+    case 0: silence(range(0, 10)); break;
+    case 1: silence(range(0, 5000)); break;
+    case 2: silence(range(ONE_SECOND - 10, ONE_SECOND + 10)); break;
+    case 3: break;
+  }
+}
+
+/* The first few samples of a pattern, but not all */
+void near_miss(const char *pattern, int samples)
+{
+  output_samples(pattern, range(1, samples - 1));
+}
+
+/* Name data following the first syncblip; the name starts in byte #0
+ * of the first name sample, then continues with byte #1 and byte #0 of
+ * each following sample. */
+void name(void)
+{
+  char bytes[NAMELEN + 2];
+  char sample[SAMPLESIZE] = { 0 };
+  int byteno;
+
+  bytes[0] = 0;
+  for (byteno = 1; byteno <= NAMELEN; byteno++)
+    bytes[byteno] = name_chars[rnd(sizeof(name_chars) - 1)];
+  bytes[NAMELEN + 1] = 0;
+
+  silence(NAME_OFFSET - 1);
+  for (byteno = 0; byteno < NAMELEN + 2; byteno += 2) {
+    sample[1] = bytes[byteno];
+    sample[0] = bytes[byteno + 1];
+    output_samples(sample, 1);
+  }
+}
+
+void song(void)
+{
+  int pairs = rnd(8) ? 6 : range(0, 5); /* sometimes truncated */
+  int pairlen = range(100, 5000);
+  int pair;
+
+  noise(range(0, 5000));
+  if (rnd(2))
+    near_miss(synctone_data, SYNCTONESIZE);
+  random_silence();
+  output_samples(synctone_data, 1); /* first sample is silence */
+  pair = range(1, 50); /* sync tone length, in patterns */
+  while (pair--)
+    output_samples(synctone_data + SAMPLESIZE, SYNCTONESIZE - 1);
+  noise(range(0, 200));
+
+  output_samples(syncblip_data, SYNCBLIPSIZE);
+  name();
+  noise(range(0, 1000));
+
+  for (pair = 0; pair < pairs; pair++) {
+    output_samples(syncblip_data, SYNCBLIPSIZE);
+    if (rnd(4) == 0)
+      random_silence();
+    noise(pairlen + (rnd(4) ? 0 : range(-50, 50))); /* not always equal */
+    if (rnd(4) == 0)
+      near_miss(syncblip_data, SYNCBLIPSIZE);
+  }
+  random_silence();
+}
+
+int main(int argc, char **argv)
+{
+  int songs;
+
+  if (argc < 2) {
+    fprintf(stderr, "Usage: d8gen <seed>\n");
+    return 1;
+  }
+  rand_state = strtoul(argv[1], NULL, 0);
+
+  songs = range(0, 3);
+  while (songs--)
+    song();
+  noise(range(0, 100));
+  random_silence();
+  fwrite("\x12\x34\x56", 1, rnd(SAMPLESIZE), stdout); /* partial sample */
+
+  return 0;
+}
@@ -59,6 +59,21 @@ run_test() {
   fi
 }
 
+# Compare an additional output file from the previous test
+compare_file() {
+  testname=$1
+  testfile=$2
+  reffile=$3
+  echo "Comparing $testfile" | log
+  cmp -b $testfile $reffile 2>&1 >> $LOGFILE 
+  if [ $? -eq 0 ]; then
+    echo "Test $testname $testfile OK" | log_and_print
+  else
+    echo "Test $testname $testfile FAILED" | log_and_print
+    FAILED=y
+  fi
+}
+
 LOGFILE=d8bup.log
 [ "$1" = "" ] || LOGFILE=$1
 rm -f $LOGFILE
@@ -97,6 +112,22 @@ run_test 12 "extract using -C 2" "./d8bup -t -C 2" 0 combined.raw passthru.raw
 # data burst.
 run_test 13 "-S -E options" "./d8bup -S -E" 0 12345678.raw se-options.raw
 
+# Tee mode: cut to stdout while writing a pass through copy to tee.raw
+# from the same input pass.
+rm -f tee.raw
+run_test 14 "tee using -c 2 -T -t" "./d8bup -c 2 -T -t -o tee.raw" 0 12345678.raw truncated-2.raw
+compare_file 14 tee.raw passthru.raw
+
+# Split mode: with a 1s gap and 1s of post roll, the first region is the
+# same as the output from -S -E above.
+rm -f split-*.raw
+run_test 15 "split using -P -A" "./d8bup -t -T -P 44100 -A 44100 -o split" 0 12345678.raw passthru.raw
+compare_file 15 split-01.raw se-options.raw
+
+# Real time pacing (-p) must not change the output; this takes as long
+# as the expanded song.
+run_test 16 "expand using -x 2 -p" "./d8bup -x 2 -p" 0 truncated-2.raw expanded-2.raw
+
 if [ "$FAILED" ]; then
   echo "Something FAILED!" | log_and_print
 else